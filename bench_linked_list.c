@@ -0,0 +1,343 @@
+#include "linked_list.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "common_defs.h"
+#include "perf_counters.h"
+
+#include "gitdata.h"
+
+// Values stay below this so they fit whatever integer type Node.data uses.
+#define VALUE_RANGE 30000
+// Marker values for nodes the benchmark adds and removes again.
+#define MARK_INSERT 30001
+#define MARK_BEFORE 30002
+// Rough number of node visits each O(n) operation is allowed per list size.
+#define VISIT_BUDGET 100000000L
+#define MAX_OPS 1000
+
+static inline long long now_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static PerfCase perf;
+
+// Starts the timer and hardware counters for one operation; report() stops them.
+static long long op_start()
+{
+    perf_begin(&perf);
+    return now_ns();
+}
+
+// ops counts API calls (unit "call"), or elements visited for the hand-written
+// traversal loops (unit "element"); ns_per_op is per that unit.
+static void report(const char *mode, long size, const char *op, const char *unit, long ops, long long ns, double bytes)
+{
+    char perf_name[128];
+    snprintf(perf_name, sizeof(perf_name), "bench_linked_list/%s/%ld/%s", mode, size, op);
+    perf_end(&perf, perf_name);
+
+    // mode,size,op,unit,ops,ns_per_op,mb_per_s
+    printf("%s,%ld,%s,%s,%ld,%.2f,%.1f\n", mode, size, op, unit, ops, ops ? (double)ns / ops : 0.0,
+           bytes > 0 && ns > 0 ? bytes / (ns / 1e9) / 1e6 : 0.0);
+    fflush(stdout);
+}
+
+// Value stored at position i. Values rise evenly over the whole list, so the
+// first occurrence of a key taken from a random position lies anywhere in it.
+static int value_at(long i, long size)
+{
+    return (int)(i * VALUE_RANGE / size);
+}
+
+// Number of repetitions for operations that walk the list, so large sizes stay bounded.
+static long ops_for(long size)
+{
+    long ops = VISIT_BUDGET / size;
+    if (ops < 1)
+    {
+        ops = 1;
+    }
+    if (ops > MAX_OPS)
+    {
+        ops = MAX_OPS;
+    }
+    return ops;
+}
+
+// ********* Linked list *********
+
+static void bench_list(long size)
+{
+    const char *mode = "list";
+    long ops = ops_for(size);
+    long long t0;
+    volatile long sink = 0;
+
+    Node *head = NULL;
+    list_init(&head, sizeof(Node) * (size + 2 * ops));
+
+    // Build in order with list_insert_after on the tail we track, the only O(1) append.
+    t0 = op_start();
+    list_insert(&head, 0);
+    Node *tail = head;
+    for (long i = 1; i < size; i++)
+    {
+        list_insert_after(tail, value_at(i, size));
+        tail = tail->next;
+    }
+    report(mode, size, "insert_after", "call", size, now_ns() - t0, 0);
+
+    // list_insert appends after a full walk.
+    t0 = op_start();
+    for (long k = 0; k < ops; k++)
+    {
+        list_insert(&head, MARK_INSERT);
+    }
+    report(mode, size, "insert", "call", ops, now_ns() - t0, 0);
+
+    // The appended markers sit at the end, so each delete scans the whole list.
+    t0 = op_start();
+    for (long k = 0; k < ops; k++)
+    {
+        list_delete(&head, MARK_INSERT);
+    }
+    report(mode, size, "delete", "call", ops, now_ns() - t0, 0);
+
+    // Inserting before the last node needs a scan for its predecessor.
+    t0 = op_start();
+    for (long k = 0; k < ops; k++)
+    {
+        list_insert_before(&head, tail, MARK_BEFORE);
+    }
+    report(mode, size, "insert_before", "call", ops, now_ns() - t0, 0);
+    for (long k = 0; k < ops; k++)
+    {
+        list_delete(&head, MARK_BEFORE);
+    }
+
+    // Keys from random positions, so the average hit walks half the list.
+    t0 = op_start();
+    for (long k = 0; k < ops; k++)
+    {
+        Node *found = list_search(&head, value_at(rand() % size, size));
+        sink += found != NULL;
+    }
+    report(mode, size, "search", "call", ops, now_ns() - t0, 0);
+
+    // An absent key always walks the whole list.
+    t0 = op_start();
+    for (long k = 0; k < ops; k++)
+    {
+        Node *found = list_search(&head, MARK_BEFORE);
+        sink += found != NULL;
+    }
+    report(mode, size, "search_miss", "call", ops, now_ns() - t0, 0);
+
+    t0 = op_start();
+    sink += list_count_nodes(&head);
+    report(mode, size, "count_nodes", "call", 1, now_ns() - t0, 0);
+
+    t0 = op_start();
+    for (Node *current = head; current; current = current->next)
+    {
+        sink += current->data;
+    }
+    report(mode, size, "traversal", "element", size, now_ns() - t0, (double)size * sizeof(Node));
+
+    // Send the printed range to /dev/null so terminal speed does not count.
+    fflush(stdout);
+    int saved = dup(STDOUT_FILENO);
+    int devnull = open("/dev/null", O_WRONLY);
+    if (saved < 0 || devnull < 0 || dup2(devnull, STDOUT_FILENO) < 0)
+    {
+        printf_red("Failed to redirect stdout to /dev/null for list_display_range.\n");
+        exit(EXIT_FAILURE);
+    }
+    t0 = op_start();
+    list_display_range(&head, NULL, NULL);
+    fflush(stdout);
+    long long display_ns = now_ns() - t0;
+    if (dup2(saved, STDOUT_FILENO) < 0)
+    {
+        // stdout still points at /dev/null, so report on stderr.
+        perror("Failed to restore stdout after list_display_range");
+        exit(EXIT_FAILURE);
+    }
+    close(devnull);
+    close(saved);
+    report(mode, size, "display_range", "call", 1, display_ns, 0);
+
+    t0 = op_start();
+    list_cleanup(&head);
+    report(mode, size, "cleanup", "call", 1, now_ns() - t0, 0);
+    my_assert(head == NULL);
+    (void)sink;
+}
+
+// ********* Dynamic array baseline *********
+
+// Doubles the array when full; a failed allocation ends the benchmark.
+static int *array_reserve(int *values, long count, long *capacity)
+{
+    if (count < *capacity)
+    {
+        return values;
+    }
+    *capacity *= 2;
+    values = realloc(values, sizeof(int) * *capacity);
+    if (values == NULL)
+    {
+        printf_red("Failed to grow the array baseline to %ld elements.\n", *capacity);
+        exit(EXIT_FAILURE);
+    }
+    return values;
+}
+
+static void bench_array(long size)
+{
+    const char *mode = "array";
+    long ops = ops_for(size);
+    long long t0;
+    volatile long sink = 0;
+
+    long capacity = 16, count = 0;
+    int *values = malloc(sizeof(int) * capacity);
+    if (values == NULL)
+    {
+        printf_red("Failed to allocate the array baseline.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    t0 = op_start();
+    for (long i = 0; i < size; i++)
+    {
+        values = array_reserve(values, count, &capacity);
+        values[count++] = value_at(i, size);
+    }
+    report(mode, size, "insert_after", "call", size, now_ns() - t0, 0);
+
+    // Delete by value of elements at the end, mirroring list_delete.
+    for (long k = 0; k < ops; k++)
+    {
+        values = array_reserve(values, count, &capacity);
+        values[count++] = MARK_INSERT;
+    }
+    t0 = op_start();
+    for (long k = 0; k < ops; k++)
+    {
+        for (long i = 0; i < count; i++)
+        {
+            if (values[i] == MARK_INSERT)
+            {
+                memmove(values + i, values + i + 1, sizeof(int) * (count - i - 1));
+                count--;
+                break;
+            }
+        }
+    }
+    report(mode, size, "delete", "call", ops, now_ns() - t0, 0);
+
+    // Insert before the last element, mirroring list_insert_before.
+    t0 = op_start();
+    for (long k = 0; k < ops; k++)
+    {
+        values = array_reserve(values, count, &capacity);
+        memmove(values + count, values + count - 1, sizeof(int));
+        values[count - 1] = MARK_BEFORE;
+        count++;
+    }
+    report(mode, size, "insert_before", "call", ops, now_ns() - t0, 0);
+    // Drop the markers but keep the original last element behind them.
+    values[count - ops - 1] = values[count - 1];
+    count -= ops;
+
+    t0 = op_start();
+    for (long k = 0; k < ops; k++)
+    {
+        int key = value_at(rand() % size, size);
+        for (long i = 0; i < count; i++)
+        {
+            if (values[i] == key)
+            {
+                sink += i;
+                break;
+            }
+        }
+    }
+    report(mode, size, "search", "call", ops, now_ns() - t0, 0);
+
+    t0 = op_start();
+    for (long k = 0; k < ops; k++)
+    {
+        for (long i = 0; i < count; i++)
+        {
+            if (values[i] == MARK_BEFORE)
+            {
+                sink += i;
+                break;
+            }
+        }
+    }
+    report(mode, size, "search_miss", "call", ops, now_ns() - t0, 0);
+
+    t0 = op_start();
+    for (long i = 0; i < count; i++)
+    {
+        sink += values[i];
+    }
+    report(mode, size, "traversal", "element", size, now_ns() - t0, (double)size * sizeof(int));
+
+    t0 = op_start();
+    free(values);
+    report(mode, size, "cleanup", "call", 1, now_ns() - t0, 0);
+    (void)sink;
+}
+
+int main(int argc, char *argv[])
+{
+    // stdout carries only the CSV table, so version information goes to stderr.
+#ifdef VERSION
+    fprintf(stderr, "Build Version; %s \n", VERSION);
+#endif
+    fprintf(stderr, "Git Version; %s/%s \n", git_date, git_sha);
+
+    if (argc < 2)
+    {
+        printf("Usage: %s <max list size>\n", argv[0]);
+        printf("Sweeps list sizes 1K, 10K, ... up to <max list size> (10000000 for the full run)\n");
+        printf("and prints one CSV row per storage mode, size and operation:\n");
+        printf("  mode,size,op,unit,ops,ns_per_op,mb_per_s\n");
+        printf("unit is call for API calls (ns_per_op is ns per call; count_nodes,\n");
+        printf("display_range and cleanup are one call over the whole list) and element\n");
+        printf("for traversal (ns per element visited, with bandwidth in mb_per_s).\n");
+        printf("Modes: list (Node list through linked_list.c), array (plain dynamic array baseline).\n");
+        printf("op names are shared by all modes; in list mode op <x> times list_<x>(),\n");
+        printf("search_miss is list_search for an absent value, and insert_after builds\n");
+        printf("the list the way append builds the array.\n");
+        printf("Set PERF_REPORT=<file> to append hardware counters per operation as JSON.\n");
+        return 1;
+    }
+
+    long max_size = atol(argv[1]);
+    if (max_size < 1000)
+    {
+        printf_red("max list size must be at least 1000.\n");
+        return 1;
+    }
+
+    srand(12345);
+    printf("mode,size,op,unit,ops,ns_per_op,mb_per_s\n");
+    for (long size = 1000; size <= max_size; size *= 10)
+    {
+        bench_list(size);
+        bench_array(size);
+    }
+    return 0;
+}
@@ -0,0 +1,460 @@
+#include "memory_manager.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <unistd.h>
+#include "common_defs.h"
+#include "perf_counters.h"
+
+#include "gitdata.h"
+
+// Blocks each thread keeps live in the churn workload.
+#define CHURN_SLOTS 64
+// Largest block requested by any workload.
+#define MAX_BLOCK 256
+// Slots shared by all threads in the shared-pool workload.
+#define SHARED_SLOTS 4096
+// Depth of the producer -> consumer hand-off ring.
+#define RING_SIZE 256
+
+// The memory manager API makes no thread-safety promise, so by default every
+// mem_alloc/mem_free goes through one harness lock and we measure the time
+// spent waiting on it. Build with -DMM_THREADSAFE to call the allocator
+// directly when it does its own locking.
+#ifndef MM_THREADSAFE
+static pthread_mutex_t mm_lock = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+typedef struct
+{
+    int id;
+    long ops;
+    unsigned int seed;
+    long done;
+    long failed;
+    long long lock_wait_ns;
+    long *latency; // ns per operation, ops entries
+    long nlat;
+    void *(*worker)(void *);
+    long long start_ns;
+    long long end_ns;
+} ThreadStats;
+
+typedef struct
+{
+    _Atomic(void *) slot[RING_SIZE];
+    atomic_long head;
+    atomic_long tail;
+    atomic_int finished;
+} Ring;
+
+static Ring *rings;
+static _Atomic(void *) shared_slots[SHARED_SLOTS];
+static pthread_barrier_t start_barrier;
+
+static inline long long now_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+#ifndef MM_THREADSAFE
+// Takes the harness lock. Only time spent blocked after a failed trylock counts
+// as lock wait, so an uncontended run reports close to zero.
+static void harness_lock(ThreadStats *st)
+{
+    if (pthread_mutex_trylock(&mm_lock) == 0)
+    {
+        return;
+    }
+    long long t0 = now_ns();
+    pthread_mutex_lock(&mm_lock);
+    st->lock_wait_ns += now_ns() - t0;
+}
+#endif
+
+static void *bench_alloc(ThreadStats *st, size_t size)
+{
+    long long t0 = now_ns();
+#ifndef MM_THREADSAFE
+    harness_lock(st);
+#endif
+    void *p = mem_alloc(size);
+#ifndef MM_THREADSAFE
+    pthread_mutex_unlock(&mm_lock);
+#endif
+    if (st->nlat < st->ops)
+    {
+        st->latency[st->nlat++] = (long)(now_ns() - t0);
+    }
+    st->done++;
+    if (p == NULL)
+    {
+        st->failed++;
+    }
+    else
+    {
+        *(char *)p = (char)size; // Touch the block like a real caller would
+    }
+    return p;
+}
+
+static void bench_free(ThreadStats *st, void *p)
+{
+    long long t0 = now_ns();
+#ifndef MM_THREADSAFE
+    harness_lock(st);
+#endif
+    mem_free(p);
+#ifndef MM_THREADSAFE
+    pthread_mutex_unlock(&mm_lock);
+#endif
+    if (st->nlat < st->ops)
+    {
+        st->latency[st->nlat++] = (long)(now_ns() - t0);
+    }
+    st->done++;
+}
+
+static size_t random_size(ThreadStats *st)
+{
+    return 1 + rand_r(&st->seed) % MAX_BLOCK;
+}
+
+// ********* Workloads *********
+
+// Each thread allocates and frees its own blocks; nothing crosses threads.
+static void *churn_worker(void *arg)
+{
+    ThreadStats *st = arg;
+    void *live[CHURN_SLOTS] = {0};
+
+    while (st->done < st->ops)
+    {
+        int k = rand_r(&st->seed) % CHURN_SLOTS;
+        if (live[k])
+        {
+            bench_free(st, live[k]);
+            live[k] = NULL;
+        }
+        else
+        {
+            live[k] = bench_alloc(st, random_size(st));
+        }
+    }
+    for (int k = 0; k < CHURN_SLOTS; k++)
+    {
+        if (live[k])
+        {
+            bench_free(st, live[k]);
+        }
+    }
+    return NULL;
+}
+
+// Even threads allocate and hand blocks to the next (odd) thread, which frees them.
+static void *prodcons_worker(void *arg)
+{
+    ThreadStats *st = arg;
+    Ring *ring = &rings[st->id / 2];
+
+    if (st->id % 2 == 0)
+    {
+        while (st->done < st->ops)
+        {
+            long head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+            if (head - atomic_load_explicit(&ring->tail, memory_order_acquire) >= RING_SIZE)
+            {
+                sched_yield();
+                continue;
+            }
+            void *p = bench_alloc(st, random_size(st));
+            if (p == NULL)
+            {
+                sched_yield();
+                continue;
+            }
+            atomic_store_explicit(&ring->slot[head % RING_SIZE], p, memory_order_relaxed);
+            atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+        }
+        atomic_store_explicit(&ring->finished, 1, memory_order_release);
+    }
+    else
+    {
+        for (;;)
+        {
+            long tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+            if (tail == atomic_load_explicit(&ring->head, memory_order_acquire))
+            {
+                if (atomic_load_explicit(&ring->finished, memory_order_acquire) &&
+                    tail == atomic_load_explicit(&ring->head, memory_order_acquire))
+                {
+                    break;
+                }
+                sched_yield();
+                continue;
+            }
+            void *p = atomic_load_explicit(&ring->slot[tail % RING_SIZE], memory_order_relaxed);
+            atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+            bench_free(st, p);
+        }
+    }
+    return NULL;
+}
+
+// All threads pick random slots in one shared table: an empty slot gets a new
+// block, a full one has its block freed, whichever thread allocated it.
+static void *shared_worker(void *arg)
+{
+    ThreadStats *st = arg;
+
+    while (st->done < st->ops)
+    {
+        int k = rand_r(&st->seed) % SHARED_SLOTS;
+        void *p = atomic_exchange(&shared_slots[k], NULL);
+        if (p)
+        {
+            bench_free(st, p);
+        }
+        else
+        {
+            p = bench_alloc(st, random_size(st));
+            void *old = atomic_exchange(&shared_slots[k], p);
+            if (old)
+            {
+                bench_free(st, old);
+            }
+        }
+    }
+    return NULL;
+}
+
+// ********* Driver *********
+
+// Releases all workers together and times each one from its own start to end,
+// so the run time does not depend on when the main thread gets scheduled.
+static void *thread_main(void *arg)
+{
+    ThreadStats *st = arg;
+    pthread_barrier_wait(&start_barrier);
+    st->start_ns = now_ns();
+    st->worker(st);
+    st->end_ns = now_ns();
+    return NULL;
+}
+
+typedef struct
+{
+    const char *name;
+    void *(*worker)(void *);
+    int pairs; // Needs an even number of threads
+} Workload;
+
+static const Workload workloads[] = {
+    {"churn", churn_worker, 0},
+    {"prodcons", prodcons_worker, 1},
+    {"shared", shared_worker, 0},
+};
+
+static int cmp_long(const void *a, const void *b)
+{
+    long x = *(const long *)a, y = *(const long *)b;
+    return (x > y) - (x < y);
+}
+
+// Prints one CSV row. <base> holds the throughput of the first run of the
+// workload, which the speedup column is relative to.
+static void run_workload(const Workload *w, int nthreads, long ops, double *base)
+{
+    // Enough room for every live block of every workload, with headroom for fragmentation.
+    int live = nthreads * CHURN_SLOTS + SHARED_SLOTS + (nthreads / 2 + 1) * RING_SIZE;
+    mem_init(live * MAX_BLOCK * 2);
+
+    pthread_t threads[nthreads];
+    ThreadStats stats[nthreads];
+    rings = calloc(nthreads / 2 + 1, sizeof(Ring));
+    memset(shared_slots, 0, sizeof(shared_slots));
+    pthread_barrier_init(&start_barrier, NULL, nthreads + 1);
+
+    // Counters are inherited by the worker threads, so open them before creating any.
+    PerfCase perf;
+    perf_begin(&perf);
+    for (int i = 0; i < nthreads; i++)
+    {
+        memset(&stats[i], 0, sizeof(ThreadStats));
+        stats[i].id = i;
+        stats[i].ops = ops;
+        stats[i].seed = 12345 + i;
+        stats[i].latency = malloc(sizeof(long) * ops);
+        stats[i].worker = w->worker;
+        pthread_create(&threads[i], NULL, thread_main, &stats[i]);
+    }
+
+    pthread_barrier_wait(&start_barrier);
+    long long first_start = 0, last_end = 0;
+    for (int i = 0; i < nthreads; i++)
+    {
+        pthread_join(threads[i], NULL);
+        if (i == 0 || stats[i].start_ns < first_start)
+        {
+            first_start = stats[i].start_ns;
+        }
+        if (stats[i].end_ns > last_end)
+        {
+            last_end = stats[i].end_ns;
+        }
+    }
+    double seconds = (last_end - first_start) / 1e9;
+    char perf_name[64];
+    snprintf(perf_name, sizeof(perf_name), "bench_memory_manager/%s/%d", w->name, nthreads);
+    perf_end(&perf, perf_name);
+
+    long total = 0, failed = 0, nlat = 0;
+    long long lock_wait = 0;
+    for (int i = 0; i < nthreads; i++)
+    {
+        total += stats[i].done;
+        failed += stats[i].failed;
+        nlat += stats[i].nlat;
+        lock_wait += stats[i].lock_wait_ns;
+    }
+
+    long *lat = malloc(sizeof(long) * (nlat ? nlat : 1));
+    long n = 0;
+    for (int i = 0; i < nthreads; i++)
+    {
+        memcpy(lat + n, stats[i].latency, sizeof(long) * stats[i].nlat);
+        n += stats[i].nlat;
+        free(stats[i].latency);
+    }
+    qsort(lat, nlat, sizeof(long), cmp_long);
+    long p50 = nlat ? lat[nlat / 2] : 0;
+    long p99 = nlat ? lat[nlat * 99 / 100] : 0;
+    long p999 = nlat ? lat[nlat * 999 / 1000] : 0;
+
+    // Drain whatever the shared workload left behind before tearing down the pool.
+    ThreadStats cleanup = {0};
+    for (int k = 0; k < SHARED_SLOTS; k++)
+    {
+        if (shared_slots[k])
+        {
+            bench_free(&cleanup, shared_slots[k]);
+        }
+    }
+
+    double mops = total / seconds / 1e6;
+    if (*base == 0)
+    {
+        *base = mops;
+    }
+    printf("%s,%d,%ld,%ld,%.4f,%.3f,%.2f,%ld,%ld,%ld,", w->name, nthreads, total, failed, seconds, mops,
+           *base > 0 ? mops / *base : 0.0, p50, p99, p999);
+#ifdef MM_THREADSAFE
+    // No harness lock, so there is no wait time to report.
+    (void)lock_wait;
+    printf("NA,NA\n");
+#else
+    printf("%.3f,%.1f\n", lock_wait / 1e6, seconds > 0 ? 100.0 * lock_wait / 1e9 / (seconds * nthreads) : 0.0);
+#endif
+    fflush(stdout);
+
+    free(lat);
+    free(rings);
+    pthread_barrier_destroy(&start_barrier);
+    mem_deinit();
+}
+
+static void run_scaling(const Workload *w, int max_threads, long ops)
+{
+    double base = 0;
+    int last = 0;
+    for (int n = 1; n <= max_threads; n = (n * 2 > max_threads && n < max_threads) ? max_threads : n * 2)
+    {
+        int threads = n;
+        // Paired workloads need an even count; round to the nearest one that
+        // does not exceed max_threads.
+        if (w->pairs && threads % 2)
+        {
+            threads = threads + 1 <= max_threads ? threads + 1 : threads - 1;
+        }
+        if (threads < 1)
+        {
+            fprintf(stderr, "%s needs at least 2 threads, skipped.\n", w->name);
+            continue;
+        }
+        if (threads == last)
+        {
+            continue;
+        }
+        last = threads;
+        run_workload(w, threads, ops, &base);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    // stdout carries only the CSV table, so version information goes to stderr.
+#ifdef VERSION
+    fprintf(stderr, "Build Version; %s \n", VERSION);
+#endif
+    fprintf(stderr, "Git Version; %s/%s \n", git_date, git_sha);
+
+    if (argc < 2)
+    {
+        printf("Usage: %s <workload> [max threads] [ops per thread]\n", argv[0]);
+        printf("Available workloads:\n");
+        printf(" 1. churn - Thread-local alloc/free of random sizes\n");
+        printf(" 2. prodcons - Producer threads allocate, consumer threads free\n");
+        printf("    (runs in pairs: odd thread counts are rounded to an even count no\n");
+        printf("    larger than max threads, and it is skipped when max threads is 1)\n");
+        printf(" 3. shared - Random alloc/free over one table shared by all threads\n");
+        printf(" 0. Run all workloads\n");
+        printf("\nmax threads defaults to nproc, ops per thread to 200000.\n");
+        printf("stdout is one CSV table; speedup is relative to the first thread count of each workload.\n");
+        printf("Set PERF_REPORT=<file> to append hardware counters per run as JSON.\n");
+#ifdef MM_THREADSAFE
+        printf("Built with MM_THREADSAFE; the allocator is called without the harness lock,\n");
+        printf("so lock_wait_ms and lock_wait_pct are reported as NA.\n");
+#endif
+        return 1;
+    }
+
+    int max_threads = sysconf(_SC_NPROCESSORS_ONLN);
+    long ops = 200000;
+    if (argc > 2)
+    {
+        max_threads = atoi(argv[2]);
+    }
+    if (argc > 3)
+    {
+        ops = atol(argv[3]);
+    }
+    if (max_threads < 1 || ops < 1)
+    {
+        printf_red("max threads and ops per thread must be positive.\n");
+        return 1;
+    }
+
+    int nworkloads = sizeof(workloads) / sizeof(workloads[0]);
+    int choice = atoi(argv[1]);
+    if (choice < 0 || choice > nworkloads)
+    {
+        printf("Invalid workload\n");
+        return 1;
+    }
+
+    printf("workload,threads,ops,failed,seconds,mops,speedup,p50_ns,p99_ns,p999_ns,lock_wait_ms,lock_wait_pct\n");
+    for (int i = 0; i < nworkloads; i++)
+    {
+        if (choice == 0 || choice == i + 1)
+        {
+            run_scaling(&workloads[i], max_threads, ops);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,217 @@
+// perf_counters.h
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+// Hardware counter instrumentation for the test and benchmark harnesses.
+//
+// Wrap a case with perf_begin()/perf_end(), or a single test call with
+// PERF_CASE(test_xxx(...)). When the PERF_REPORT environment variable names a
+// file, each case appends one JSON object to it (JSON lines) with wall-clock
+// time and the counters below. Counters the kernel refuses (no PMU in a VM,
+// perf_event_paranoid, ...) are reported as null; without PERF_REPORT nothing
+// is opened and nothing is written.
+
+#define PERF_NCOUNTERS 6
+
+static const char *perf_counter_names[PERF_NCOUNTERS] = {
+    "cycles", "instructions", "branch_misses", "l1d_misses", "llc_misses", "dtlb_misses"};
+
+#define PERF_CACHE(cache) ((cache) | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16))
+
+static const struct
+{
+    unsigned int type;
+    unsigned long long config;
+} perf_counter_events[PERF_NCOUNTERS] = {
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+    {PERF_TYPE_HW_CACHE, PERF_CACHE(PERF_COUNT_HW_CACHE_L1D)},
+    {PERF_TYPE_HW_CACHE, PERF_CACHE(PERF_COUNT_HW_CACHE_LL)},
+    {PERF_TYPE_HW_CACHE, PERF_CACHE(PERF_COUNT_HW_CACHE_DTLB)},
+};
+
+typedef struct
+{
+    int enabled;
+    int fd[PERF_NCOUNTERS];
+    long long wall_start;
+} PerfCase;
+
+static inline long long perf_wall_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+// Opens and starts the counters. Threads created after this call are counted too.
+static inline void perf_begin(PerfCase *pc)
+{
+    pc->enabled = getenv("PERF_REPORT") != NULL;
+    for (int i = 0; i < PERF_NCOUNTERS; i++)
+    {
+        pc->fd[i] = -1;
+        if (!pc->enabled)
+        {
+            continue;
+        }
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = perf_counter_events[i].type;
+        attr.config = perf_counter_events[i].config;
+        attr.disabled = 1;
+        attr.inherit = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        pc->fd[i] = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    }
+    pc->wall_start = perf_wall_ns();
+    for (int i = 0; i < PERF_NCOUNTERS; i++)
+    {
+        if (pc->fd[i] >= 0)
+        {
+            ioctl(pc->fd[i], PERF_EVENT_IOC_RESET, 0);
+            ioctl(pc->fd[i], PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+}
+
+// Writes <s> as a JSON string literal, escaping quotes, backslashes and control characters.
+static inline void perf_json_string(FILE *out, const char *s)
+{
+    fputc('"', out);
+    for (; *s; s++)
+    {
+        unsigned char c = (unsigned char)*s;
+        if (c == '"' || c == '\\')
+        {
+            fprintf(out, "\\%c", c);
+        }
+        else if (c < 0x20)
+        {
+            fprintf(out, "\\u%04x", c);
+        }
+        else
+        {
+            fputc(c, out);
+        }
+    }
+    fputc('"', out);
+}
+
+// Stops the counters and appends the case, named <name>, to the PERF_REPORT file.
+// <completed> is false when the process exits while the case is still running.
+static inline void perf_finish(PerfCase *pc, const char *name, int completed)
+{
+    for (int i = 0; i < PERF_NCOUNTERS; i++)
+    {
+        if (pc->fd[i] >= 0)
+        {
+            ioctl(pc->fd[i], PERF_EVENT_IOC_DISABLE, 0);
+        }
+    }
+    long long wall_ns = perf_wall_ns() - pc->wall_start;
+    if (!pc->enabled)
+    {
+        return;
+    }
+
+    FILE *report = fopen(getenv("PERF_REPORT"), "a");
+    if (report)
+    {
+        fprintf(report, "{\"case\": ");
+        perf_json_string(report, name);
+        fprintf(report, ", \"completed\": %s, \"wall_ns\": %lld", completed ? "true" : "false", wall_ns);
+    }
+    for (int i = 0; i < PERF_NCOUNTERS; i++)
+    {
+        // value, time enabled, time running; scale up if the PMU was multiplexed.
+        unsigned long long values[3];
+        int ok = pc->fd[i] >= 0 && read(pc->fd[i], values, sizeof(values)) == sizeof(values) && values[2] > 0;
+        if (report && ok)
+        {
+            fprintf(report, ", \"%s\": %llu", perf_counter_names[i],
+                    (unsigned long long)((double)values[0] * values[1] / values[2]));
+        }
+        else if (report)
+        {
+            fprintf(report, ", \"%s\": null", perf_counter_names[i]);
+        }
+        if (pc->fd[i] >= 0)
+        {
+            close(pc->fd[i]);
+            pc->fd[i] = -1;
+        }
+    }
+    if (report)
+    {
+        fprintf(report, "}\n");
+        fclose(report);
+    }
+    else
+    {
+        perror("PERF_REPORT");
+    }
+}
+
+static inline void perf_end(PerfCase *pc, const char *name)
+{
+    perf_finish(pc, name, 1);
+}
+
+// The case PERF_CASE is running, so a my_assert() failure that exits still
+// leaves a record, marked as not completed.
+static PerfCase perf_open_case;
+static const char *perf_open_name;
+
+static inline void perf_flush_open_case(void)
+{
+    const char *name = perf_open_name;
+    if (name)
+    {
+        perf_open_name = NULL;
+        perf_finish(&perf_open_case, name, 0);
+    }
+}
+
+static inline void perf_case_begin(const char *name)
+{
+    static int registered;
+    if (!registered)
+    {
+        atexit(perf_flush_open_case);
+        registered = 1;
+    }
+    perf_open_name = name;
+    perf_begin(&perf_open_case);
+}
+
+static inline void perf_case_end()
+{
+    const char *name = perf_open_name;
+    perf_open_name = NULL;
+    perf_end(&perf_open_case, name);
+}
+
+// Runs one test call as its own case, named after the call itself.
+#define PERF_CASE(call)          \
+    do                           \
+    {                            \
+        perf_case_begin(#call);  \
+        call;                    \
+        perf_case_end();         \
+    } while (0)
+
+#endif // PERF_COUNTERS_H
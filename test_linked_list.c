@@ -6,6 +6,7 @@
 #include <stddef.h>
 
 #include "common_defs.h"
+#include "perf_counters.h"
 #include "gitdata.h"
 
 // Function to capture stdout output.
@@ -515,6 +516,7 @@ int main(int argc, char *argv[])
         printf(" 14. test_list_edge_cases - Test edge cases\n");
         printf(" 0. Run all tests\n");
 	printf(" 100. Run all tests; -test_list_display() \n");
+        printf("\nSet PERF_REPORT=<file> to append hardware counters per test as JSON.\n");
         return 1;
     }
 
@@ -525,83 +527,83 @@ int main(int argc, char *argv[])
         break;
     case 100:
         printf("Testing Basic Operations:\n");
-        test_list_init();
-        test_list_insert();
-        test_list_insert_after();
-        test_list_insert_before();
-        test_list_delete();
-        test_list_search();
-        test_list_count_nodes();
-        test_list_cleanup();
+        PERF_CASE(test_list_init());
+        PERF_CASE(test_list_insert());
+        PERF_CASE(test_list_insert_after());
+        PERF_CASE(test_list_insert_before());
+        PERF_CASE(test_list_delete());
+        PERF_CASE(test_list_search());
+        PERF_CASE(test_list_count_nodes());
+        PERF_CASE(test_list_cleanup());
 
         printf("\nTesting Stress and Edge Cases:\n");
-        test_list_insert_loop(1000);
-        test_list_insert_after_loop(1000);
-        test_list_delete_loop(1000);
-        test_list_search_loop(1000);
-        test_list_edge_cases();
+        PERF_CASE(test_list_insert_loop(1000));
+        PERF_CASE(test_list_insert_after_loop(1000));
+        PERF_CASE(test_list_delete_loop(1000));
+        PERF_CASE(test_list_search_loop(1000));
+        PERF_CASE(test_list_edge_cases());
         break;
     case 0:
         printf("Testing Basic Operations:\n");
-        test_list_init();
-        test_list_insert();
-        test_list_insert_after();
-        test_list_insert_before();
-        test_list_delete();
-        test_list_search();
-        test_list_display();
-        test_list_count_nodes();
-        test_list_cleanup();
+        PERF_CASE(test_list_init());
+        PERF_CASE(test_list_insert());
+        PERF_CASE(test_list_insert_after());
+        PERF_CASE(test_list_insert_before());
+        PERF_CASE(test_list_delete());
+        PERF_CASE(test_list_search());
+        PERF_CASE(test_list_display());
+        PERF_CASE(test_list_count_nodes());
+        PERF_CASE(test_list_cleanup());
 
         printf("\nTesting Stress and Edge Cases:\n");
-        test_list_insert_loop(1000);
-        test_list_insert_after_loop(1000);
-        test_list_delete_loop(1000);
-        test_list_search_loop(1000);
-        test_list_edge_cases();
+        PERF_CASE(test_list_insert_loop(1000));
+        PERF_CASE(test_list_insert_after_loop(1000));
+        PERF_CASE(test_list_delete_loop(1000));
+        PERF_CASE(test_list_search_loop(1000));
+        PERF_CASE(test_list_edge_cases());
         break;
     case 1:
-        test_list_init();
+        PERF_CASE(test_list_init());
         break;
     case 2:
 
-        test_list_insert();
+        PERF_CASE(test_list_insert());
         break;
     case 3:
-        test_list_insert_after();
+        PERF_CASE(test_list_insert_after());
         break;
     case 4:
-        test_list_insert_before();
+        PERF_CASE(test_list_insert_before());
         break;
     case 5:
-        test_list_delete();
+        PERF_CASE(test_list_delete());
         break;
     case 6:
-        test_list_search();
+        PERF_CASE(test_list_search());
         break;
     case 7:
-        test_list_display();
+        PERF_CASE(test_list_display());
         break;
     case 8:
-        test_list_count_nodes();
+        PERF_CASE(test_list_count_nodes());
         break;
     case 9:
-        test_list_cleanup();
+        PERF_CASE(test_list_cleanup());
         break;
     case 10:
-        test_list_insert_loop(1000);
+        PERF_CASE(test_list_insert_loop(1000));
         break;
     case 11:
-        test_list_insert_after_loop(1000);
+        PERF_CASE(test_list_insert_after_loop(1000));
         break;
     case 12:
-        test_list_delete_loop(1000);
+        PERF_CASE(test_list_delete_loop(1000));
         break;
     case 13:
-        test_list_search_loop(1000);
+        PERF_CASE(test_list_search_loop(1000));
         break;
     case 14:
-        test_list_edge_cases();
+        PERF_CASE(test_list_edge_cases());
         break;
 
     default:
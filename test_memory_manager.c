@@ -8,6 +8,7 @@
 #include <sys/mman.h>
 #include <fcntl.h>
 #include "common_defs.h"
+#include "perf_counters.h"
 
 #include "gitdata.h"
 
@@ -449,6 +450,7 @@ int main(int argc, char *argv[])
 	printf(" 21. test_mmap, needs LD_PRELOAD=./libmymalloc.so .\n\n");
 	
         printf(" 0. Run all tests (excluding 20)\n");
+        printf("\nSet PERF_REPORT=<file> to append hardware counters per test as JSON.\n");
         return 1;
     }
 
@@ -460,97 +462,97 @@ int main(int argc, char *argv[])
     case 0:
         // Running all tests
         printf("Testing Basic Operations:\n");
-        test_init(1024);
-        test_alloc_and_free();
-        test_resize();
+        PERF_CASE(test_init(1024));
+        PERF_CASE(test_alloc_and_free());
+        PERF_CASE(test_resize());
 
         printf("\nTesting Stress and Edge Cases:\n");
-        test_exceed_single_allocation();
-        test_exceed_cumulative_allocation();
-        test_memory_overcommit();
-        test_boundary_condition();
-        test_exact_fit_reuse();
-        test_double_free();
-        test_memory_fragmentation();
-        test_edge_case_allocations();
+        PERF_CASE(test_exceed_single_allocation());
+        PERF_CASE(test_exceed_cumulative_allocation());
+        PERF_CASE(test_memory_overcommit());
+        PERF_CASE(test_boundary_condition());
+        PERF_CASE(test_exact_fit_reuse());
+        PERF_CASE(test_double_free());
+        PERF_CASE(test_memory_fragmentation());
+        PERF_CASE(test_edge_case_allocations());
 
         printf("\nTesting Advanced Memory Management:\n");
-        test_frequent_small_allocations();
-        test_memory_reuse();
-        test_block_merging();
-        test_non_contiguous_allocation_failure();
-        test_contiguous_allocation_success();
+        PERF_CASE(test_frequent_small_allocations());
+        PERF_CASE(test_memory_reuse());
+        PERF_CASE(test_block_merging());
+        PERF_CASE(test_non_contiguous_allocation_failure());
+        PERF_CASE(test_contiguous_allocation_success());
 
         printf("\nVarious other tests:\n");
-        test_zero_alloc_and_free();
-        test_random_blocks();
-	test_init(1048576);
+        PERF_CASE(test_zero_alloc_and_free());
+        PERF_CASE(test_random_blocks());
+	PERF_CASE(test_init(1048576));
         break;
     case 1:
-        test_init(1024);
+        PERF_CASE(test_init(1024));
         break;
     case 2:
-        test_alloc_and_free();
+        PERF_CASE(test_alloc_and_free());
         break;
     case 3:
-        test_resize();
+        PERF_CASE(test_resize());
         break;
     case 4:
-        test_exceed_single_allocation();
+        PERF_CASE(test_exceed_single_allocation());
         break;
     case 5:
-        test_exceed_cumulative_allocation();
+        PERF_CASE(test_exceed_cumulative_allocation());
         break;
     case 6:
-        test_memory_overcommit();
+        PERF_CASE(test_memory_overcommit());
         break;
     case 7:
-        test_boundary_condition();
+        PERF_CASE(test_boundary_condition());
         break;
     case 8:
-        test_exact_fit_reuse();
+        PERF_CASE(test_exact_fit_reuse());
         break;
     case 9:
-        test_double_free();
+        PERF_CASE(test_double_free());
         break;
     case 10:
-        test_memory_fragmentation();
+        PERF_CASE(test_memory_fragmentation());
         break;
     case 11:
-        test_edge_case_allocations();
+        PERF_CASE(test_edge_case_allocations());
         break;
     case 12:
-        test_frequent_small_allocations();
+        PERF_CASE(test_frequent_small_allocations());
         break;
     case 13:
-        test_memory_reuse();
+        PERF_CASE(test_memory_reuse());
         break;
     case 14:
-        test_block_merging();
+        PERF_CASE(test_block_merging());
         break;
     case 15:
-        test_non_contiguous_allocation_failure();
+        PERF_CASE(test_non_contiguous_allocation_failure());
         break;
     case 16:
-        test_contiguous_allocation_success();
+        PERF_CASE(test_contiguous_allocation_success());
         break;
     case 17:
-        test_zero_alloc_and_free();
+        PERF_CASE(test_zero_alloc_and_free());
         break;
     case 18:
-      test_random_blocks();
+      PERF_CASE(test_random_blocks());
       break;
     case 19:
       printf("Test 19.\n");
-      test_init(4096);
+      PERF_CASE(test_init(4096));
       break;
     case 20:
       printf("Test 20.\n");
-      test_looking_for_out_of_bounds(atoi(argv[2]));
+      PERF_CASE(test_looking_for_out_of_bounds(atoi(argv[2])));
       break;
     case 21:
       printf("Test 21.\n");
-      test_mmap();
+      PERF_CASE(test_mmap());
       break;
     default:
       printf("Invalid test function\n");